@@ -0,0 +1,185 @@
+/**
+ * @file HtmlText.cpp
+ * @author Marc S. Ressl
+ * @brief Text extraction from HTML, shared by mkindex and edahttpd
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2022-2024 Marc S. Ressl
+ */
+
+#include <algorithm>
+#include <cctype>
+
+#include "HtmlText.h"
+
+using namespace std;
+
+/**
+ * @brief Removes HTML comments, scripts and styles (case-insensitive)
+ *
+ * @param html The HTML content
+ * @return The content with each block replaced by a space
+ */
+static string removeBlocks(const string &html)
+{
+    const string openMarkers[] = {"<!--", "<script", "<style"};
+    const string closeMarkers[] = {"-->", "</script>", "</style>"};
+    const size_t markerCount = 3;
+
+    string lower = html;
+    transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+
+    // Next occurrence of each opening marker, updated only when passed
+    size_t nextOpen[markerCount];
+    for (size_t i = 0; i < markerCount; i++)
+        nextOpen[i] = lower.find(openMarkers[i]);
+
+    string result;
+    result.reserve(html.size());
+    size_t pos = 0;
+    while (pos < html.size())
+    {
+        size_t marker = markerCount;
+        for (size_t i = 0; i < markerCount; i++)
+        {
+            if (nextOpen[i] != string::npos && nextOpen[i] < pos)
+                nextOpen[i] = lower.find(openMarkers[i], pos);
+            if (nextOpen[i] != string::npos && (marker == markerCount || nextOpen[i] < nextOpen[marker]))
+                marker = i;
+        }
+
+        if (marker == markerCount)
+        {
+            result.append(html, pos, string::npos);
+            break;
+        }
+
+        size_t blockStart = nextOpen[marker];
+        result.append(html, pos, blockStart - pos);
+        result += ' ';
+
+        // Unterminated blocks run to the end of the document
+        size_t blockEnd = lower.find(closeMarkers[marker], blockStart + openMarkers[marker].size());
+        if (blockEnd == string::npos)
+            break;
+        pos = blockEnd + closeMarkers[marker].size();
+    }
+
+    return result;
+}
+
+/**
+ * @brief Removes HTML comments, scripts, styles and tags
+ *
+ * @param html The HTML content
+ * @return The text, with each removed element replaced by a space
+ */
+string removeMarkup(const string &html)
+{
+    string text = removeBlocks(html);
+
+    // Replace each tag (a '<', at least one character, then '>') with a space
+    string result;
+    result.reserve(text.size());
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        size_t tagStart = text.find('<', pos);
+        if (tagStart == string::npos)
+        {
+            result.append(text, pos, string::npos);
+            break;
+        }
+
+        result.append(text, pos, tagStart - pos);
+        size_t tagEnd = text.find('>', tagStart + 1);
+        if (tagEnd == string::npos || tagEnd == tagStart + 1)
+        {
+            // Not a tag, keep the '<'
+            result += '<';
+            pos = tagStart + 1;
+            continue;
+        }
+
+        result += ' ';
+        pos = tagEnd + 1;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Collapses whitespace runs into single spaces and trims both ends
+ *
+ * @param text The text
+ * @return The normalized text
+ */
+string normalizeSpaces(const string &text)
+{
+    string result;
+    result.reserve(text.size());
+    bool isPendingSpace = false;
+    for (char c : text)
+    {
+        if (isspace((unsigned char)c))
+        {
+            isPendingSpace = !result.empty();
+            continue;
+        }
+
+        if (isPendingSpace)
+            result += ' ';
+        isPendingSpace = false;
+        result += c;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Normalizes a word the same way for indexing and for searching:
+ *        lowercases ASCII letters, keeps digits and non-ASCII (UTF-8) bytes,
+ *        and drops everything else
+ *
+ * @param word The word
+ * @param normalized Set to the normalized word (reused to avoid allocations)
+ */
+void normalizeWord(string_view word, string &normalized)
+{
+    normalized.clear();
+    for (char c : word)
+    {
+        unsigned char u = (unsigned char)c;
+        if (u >= 0x80 || isdigit(u))
+            normalized += c;
+        else if (isalpha(u))
+            normalized += (char)tolower(u);
+    }
+}
+
+/**
+ * @brief Extracts the normalized words of a text
+ *
+ * @param text The text
+ * @return Normalized words of at least MIN_WORD_LENGTH characters
+ */
+set<string> extractWords(const string &text)
+{
+    set<string> words;
+    string normalized;
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        while (pos < text.size() && isspace((unsigned char)text[pos]))
+            pos++;
+        size_t wordStart = pos;
+        while (pos < text.size() && !isspace((unsigned char)text[pos]))
+            pos++;
+
+        normalizeWord(string_view(text).substr(wordStart, pos - wordStart), normalized);
+        if (normalized.size() >= MIN_WORD_LENGTH)
+            words.insert(normalized);
+    }
+
+    return words;
+}
@@ -0,0 +1,29 @@
+/**
+ * @file HtmlText.h
+ * @author Marc S. Ressl
+ * @brief Text extraction from HTML, shared by mkindex and edahttpd
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2022-2024 Marc S. Ressl
+ */
+
+#ifndef HTMLTEXT_H
+#define HTMLTEXT_H
+
+#include <set>
+#include <string>
+#include <string_view>
+
+// All functions here are linear loops: std::regex recurses once per matched
+// character and overflows the stack on large inputs.
+
+std::string removeMarkup(const std::string &html);
+std::string normalizeSpaces(const std::string &text);
+
+// Shorter words are neither indexed nor searched for
+const size_t MIN_WORD_LENGTH = 3;
+
+void normalizeWord(std::string_view word, std::string &normalized);
+std::set<std::string> extractWords(const std::string &text);
+
+#endif
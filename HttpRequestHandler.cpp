@@ -13,40 +13,58 @@
 #include <iostream>
 #include <sqlite3.h>
 #include "HttpRequestHandler.h"
+#include "HtmlText.h"
 #include <string>
 #include <chrono>
 #include <vector>
 #include <set>
+#include <string_view>
 #include <algorithm>
 
 using namespace std;
 
-set<string> extractWords(const string& content) { //copied from mkindex.cpp
-    set<string> words;
-    string cleanText;
-    bool inTag = false;
+// Maximum number of results that get a snippet (keeps snippet cost bounded)
+const size_t SNIPPET_MAX_RESULTS = 20;
 
-    // Remove HTML tags
-    for (char c : content) {
-        if (c == '<') inTag = true;
-        else if (c == '>') inTag = false;
-        else if (!inTag) cleanText += c;
+string escapeHtml(const string& text) {
+    string escaped;
+    for (char c : text) {
+        if (c == '<') escaped += "&lt;";
+        else if (c == '>') escaped += "&gt;";
+        else if (c == '"') escaped += "&quot;";
+        else escaped += c;
     }
+    return escaped;
+}
 
-    // Extract words
-    stringstream ss(cleanText);
-    string word;
-    while (ss >> word) {
-        transform(word.begin(), word.end(), word.begin(), ::tolower);
-        word.erase(remove_if(word.begin(), word.end(), ::ispunct), word.end());
-        if (word.length() >= 3) words.insert(word);
+// Highlights every search word in a snippet window written by mkindex.
+// Windows are a few dozen words long, so this is cheap.
+string highlightSnippet(string_view window, const set<string>& searchWords) {
+    string snippet;
+    string normalized;
+    size_t pos = 0;
+    while (pos < window.size()) {
+        size_t wordEnd = min(window.find(' ', pos), window.size());
+        string_view word = window.substr(pos, wordEnd - pos);
+        pos = wordEnd + 1;
+
+        if (!snippet.empty()) snippet += " ";
+        normalizeWord(word, normalized);
+        if (searchWords.count(normalized))
+            snippet += "<b>" + escapeHtml(string(word)) + "</b>";
+        else
+            snippet += escapeHtml(string(word));
     }
-    return words;
+
+    return snippet;
 }
 
 HttpRequestHandler::HttpRequestHandler(string homePath)
 {
     this->homePath = homePath;
+
+    if (searchIndex.load("index.db"))
+        searchIndex.printMemoryUsage(cout);
 }
 
 /**
@@ -121,51 +139,54 @@ bool HttpRequestHandler::handleRequest(string url,
         </div>\
         ");
 		        float searchTime = 0.1F;
-        		vector<string> results;
                 auto start = chrono::steady_clock::now();
 
-        // Open the SQLite database
-        sqlite3 *db;
-        if (sqlite3_open("index.db", &db) != SQLITE_OK) {
-            cerr << "Error opening database: " << sqlite3_errmsg(db) << endl;
-            return false;
-        }
-
         // Split search string into lowercase words
-        set<string> searchWords = extractWords(searchString);  // assuming this function exists as in main()
+        set<string> searchWords = extractWords(searchString);
+
+        // Results are document ids into the in-memory index, paths are
+        // only looked up when rendering
+        vector<DocId> results = searchIndex.search(searchWords);
 
-        if (!searchWords.empty()) {
+        // Build snippets from the snippet tables written by mkindex: the
+        // window holding the earliest first occurrence of any search word,
+        // or the first window if none was recorded
+        vector<string> snippets(results.size());
+        sqlite3 *db;
+        if (!results.empty() && sqlite3_open_v2("index.db", &db, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK) {
             string sql =
-                "SELECT d.path FROM documents d "
-                "JOIN word_document wd ON d.doc_id = wd.doc_id "
-                "JOIN words w ON wd.word_id = w.word_id "
-                "WHERE w.word = ?";
-
-            // If there is more than one word, we want docs that match *all* words
-            // Use INTERSECT to get common results
-            vector<string> wordVec(searchWords.begin(), searchWords.end());
-            for (size_t i = 1; i < wordVec.size(); ++i)
-                sql += " INTERSECT " + sql;
-
-            // Prepare final query
-            sqlite3_stmt *stmt;
-            if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
-                // Bind each word
-                for (size_t i = 0; i < wordVec.size(); ++i)
-                    sqlite3_bind_text(stmt, i + 1, wordVec[i].c_str(), -1, SQLITE_STATIC);
-
-                while (sqlite3_step(stmt) == SQLITE_ROW) {
-                    const unsigned char *path = sqlite3_column_text(stmt, 0);
-                    results.push_back(string(reinterpret_cast<const char *>(path)));
+                "SELECT w.text FROM snippet_docs d "
+                "JOIN snippet_windows w ON w.doc_id = d.doc_id "
+                "WHERE d.path = ? AND w.window = COALESCE("
+                "(SELECT MIN(t.window) FROM snippet_terms t WHERE t.doc_id = d.doc_id AND t.term IN (";
+            for (size_t i = 0; i < searchWords.size(); ++i)
+                sql += i ? ", ?" : "?";
+            sql += ")), 0)";
+
+            sqlite3_stmt *windowStmt;
+            if (sqlite3_prepare_v2(db, sql.c_str(), -1, &windowStmt, nullptr) == SQLITE_OK) {
+                int parameter = 2;
+                for (auto &word : searchWords)
+                    sqlite3_bind_text(windowStmt, parameter++, word.c_str(), -1, SQLITE_STATIC);
+
+                size_t snippetCount = min(results.size(), SNIPPET_MAX_RESULTS);
+                for (size_t i = 0; i < snippetCount; ++i) {
+                    string_view path = searchIndex.getPath(results[i]);
+                    sqlite3_bind_text(windowStmt, 1, path.data(), (int)path.size(), SQLITE_STATIC);
+                    if (sqlite3_step(windowStmt) == SQLITE_ROW) {
+                        const unsigned char *window = sqlite3_column_text(windowStmt, 0);
+                        if (window)
+                            snippets[i] = highlightSnippet(string_view(reinterpret_cast<const char *>(window),
+                                                                       sqlite3_column_bytes(windowStmt, 0)),
+                                                           searchWords);
+                    }
+                    sqlite3_reset(windowStmt);
                 }
-            } else {
-                cerr << "Failed to prepare search statement: " << sqlite3_errmsg(db) << endl;
+                sqlite3_finalize(windowStmt);
             }
-
-            sqlite3_finalize(stmt);
+            sqlite3_close(db);
         }
 
-        sqlite3_close(db);
         auto end = chrono::steady_clock::now();
         searchTime = chrono::duration<float>(end - start).count();
 
@@ -174,9 +195,15 @@ bool HttpRequestHandler::handleRequest(string url,
         // Print search results
         responseString += "<div class=\"results\">" + to_string(results.size()) +
                           " results (" + to_string(searchTime) + " seconds):</div>";
-        for (auto &result : results)
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            string path(searchIndex.getPath(results[i]));
             responseString += "<div class=\"result\"><a href=\"" +
-                              result + "\">" + result + "</a></div>";
+                              path + "\">" + path + "</a>";
+            if (!snippets[i].empty())
+                responseString += "<div class=\"snippet\">" + snippets[i] + "</div>";
+            responseString += "</div>";
+        }
 
         // Trailer
         responseString += "    </article>\
@@ -11,6 +11,7 @@
 #define HTTPREQUESTHANDLER_H
 
 #include "HttpServer.h"
+#include "SearchIndex.h"
 
 class HttpRequestHandler
 {
@@ -23,6 +24,7 @@ private:
     bool serve(std::string path, std::vector<char> &response);
 
     std::string homePath;
+    SearchIndex searchIndex;
 };
 
 #endif
@@ -112,17 +112,40 @@ MHD_Result httpRequestHandlerCallback(void *cls,
     return MHD_NO;
 }
 
-HttpServer::HttpServer(int port)
+HttpServer::HttpServer(int port,
+                       HttpRequestHandler *httpRequestHandler,
+                       const HttpServerOptions &options)
 {
-    daemon = MHD_start_daemon(MHD_USE_INTERNAL_POLLING_THREAD,
-                              8000,
+    // Set before starting the daemon: its threads read it without locking
+    this->httpRequestHandler = httpRequestHandler;
+
+    // Only pass options that were set, so libmicrohttpd keeps its defaults
+    vector<MHD_OptionItem> optionItems;
+    if (options.connectionLimit)
+        optionItems.push_back({MHD_OPTION_CONNECTION_LIMIT, (intptr_t)options.connectionLimit, NULL});
+    if (options.perIpConnectionLimit)
+        optionItems.push_back({MHD_OPTION_PER_IP_CONNECTION_LIMIT, (intptr_t)options.perIpConnectionLimit, NULL});
+    if (options.connectionTimeout)
+        optionItems.push_back({MHD_OPTION_CONNECTION_TIMEOUT, (intptr_t)options.connectionTimeout, NULL});
+    if (options.threadPoolSize > 1)
+        optionItems.push_back({MHD_OPTION_THREAD_POOL_SIZE, (intptr_t)options.threadPoolSize, NULL});
+    if (options.listenBacklog)
+        optionItems.push_back({MHD_OPTION_LISTEN_BACKLOG_SIZE, (intptr_t)options.listenBacklog, NULL});
+    if (options.reusePort)
+        optionItems.push_back({MHD_OPTION_LISTENING_ADDRESS_REUSE, 1, NULL}); // SO_REUSEPORT
+    optionItems.push_back({MHD_OPTION_END, 0, NULL});
+
+    // MHD_USE_AUTO picks epoll or poll when available: select() caps
+    // connections at FD_SETSIZE regardless of the configured limit
+    daemon = MHD_start_daemon(MHD_USE_AUTO | MHD_USE_INTERNAL_POLLING_THREAD,
+                              port,
                               NULL,
                               NULL,
                               httpRequestHandlerCallback,
                               this,
+                              MHD_OPTION_ARRAY,
+                              optionItems.data(),
                               MHD_OPTION_END);
-
-    httpRequestHandler = NULL;
 }
 
 HttpServer::~HttpServer()
@@ -137,8 +160,3 @@ bool HttpServer::isRunning()
 {
     return daemon != NULL;
 }
-
-void HttpServer::setHttpRequestHandler(HttpRequestHandler *httpRequestHandler)
-{
-    this->httpRequestHandler = httpRequestHandler;
-}
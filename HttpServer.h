@@ -18,16 +18,30 @@
 
 typedef std::map<std::string, std::string> HttpArguments;
 
+/**
+ * @brief libmicrohttpd tuning options. Zero means library default.
+ */
+struct HttpServerOptions
+{
+    unsigned int connectionLimit = 0;
+    unsigned int perIpConnectionLimit = 0;
+    unsigned int connectionTimeout = 0; // seconds, also closes idle keep-alive connections
+    unsigned int threadPoolSize = 0;
+    unsigned int listenBacklog = 0;
+    bool reusePort = false;
+};
+
 class HttpRequestHandler;
 
 class HttpServer
 {
 public:
-    HttpServer(int port);
+    HttpServer(int port,
+               HttpRequestHandler *httpRequestHandler,
+               const HttpServerOptions &options = HttpServerOptions());
     ~HttpServer();
 
     bool isRunning();
-    void setHttpRequestHandler(HttpRequestHandler *httpRequestHandler);
 
 private:
     MHD_Daemon *daemon;
@@ -0,0 +1,297 @@
+/**
+ * @file SearchIndex.cpp
+ * @author Marc S. Ressl
+ * @brief In-memory search index
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2022-2024 Marc S. Ressl
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+#include <sqlite3.h>
+
+#include "HtmlText.h"
+#include "SearchIndex.h"
+
+using namespace std;
+
+// Ids and pool offsets are 32-bit
+const size_t MAX_INDEX_SIZE = numeric_limits<uint32_t>::max();
+
+/**
+ * @brief Loads documents from the FTS5 table written by mkindex
+ *
+ * @param databasePath Path to index.db
+ * @return true Index loaded
+ * @return false Database could not be read
+ */
+bool SearchIndex::load(const string &databasePath)
+{
+    sqlite3 *db;
+    if (sqlite3_open_v2(databasePath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+    {
+        cerr << "Error opening database: " << sqlite3_errmsg(db) << endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT path, content FROM search_index", -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        cerr << "Failed to prepare load statement: " << sqlite3_errmsg(db) << endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    // Temporary build state, released when load() returns
+    unordered_map<string, DocId> docIds;
+    unordered_map<string, uint32_t> termIds;
+    vector<pair<uint32_t, DocId>> termDocs;
+    vector<uint32_t> docTermIds;
+
+    pathPool.clear();
+    pathOffsets.assign(1, 0);
+
+    int stepResult;
+    bool isTooLarge = false;
+    while ((stepResult = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        const char *path = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+        const char *content = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+        if (!path || !content)
+            continue;
+
+        if (pathPool.size() + sqlite3_column_bytes(stmt, 0) > MAX_INDEX_SIZE ||
+            pathOffsets.size() > MAX_INDEX_SIZE)
+        {
+            isTooLarge = true;
+            break;
+        }
+
+        // Intern the path: rows with the same path share one document id
+        auto insertedDoc = docIds.try_emplace(path, (DocId)(pathOffsets.size() - 1));
+        DocId docId = insertedDoc.first->second;
+        if (insertedDoc.second)
+        {
+            pathPool += path;
+            pathOffsets.push_back((uint32_t)pathPool.size());
+        }
+
+        // Content is already clean: lowercase words separated by single spaces
+        docTermIds.clear();
+        string_view text(content);
+        while (!text.empty())
+        {
+            size_t wordEnd = text.find(' ');
+            string_view word = text.substr(0, wordEnd);
+            text.remove_prefix(wordEnd == string_view::npos ? text.size() : wordEnd + 1);
+
+            // Shorter words are never searched for
+            if (word.size() < MIN_WORD_LENGTH)
+                continue;
+
+            if (termIds.size() >= MAX_INDEX_SIZE)
+            {
+                isTooLarge = true;
+                break;
+            }
+
+            auto inserted = termIds.try_emplace(string(word), (uint32_t)termIds.size());
+            docTermIds.push_back(inserted.first->second);
+        }
+
+        sort(docTermIds.begin(), docTermIds.end());
+        docTermIds.erase(unique(docTermIds.begin(), docTermIds.end()), docTermIds.end());
+        for (uint32_t termId : docTermIds)
+            termDocs.push_back({termId, docId});
+
+        if (isTooLarge || termDocs.size() > MAX_INDEX_SIZE)
+        {
+            isTooLarge = true;
+            break;
+        }
+    }
+
+    if (isTooLarge)
+        cerr << "Index too large for 32-bit ids" << endl;
+    else if (stepResult != SQLITE_DONE)
+        cerr << "Failed to read index: " << sqlite3_errmsg(db) << endl;
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    if (isTooLarge || stepResult != SQLITE_DONE)
+    {
+        clear();
+        return false;
+    }
+
+    // Sort vocabulary so terms can be found by binary search
+    vector<const string *> terms(termIds.size());
+    for (auto &entry : termIds)
+        terms[entry.second] = &entry.first;
+
+    vector<uint32_t> sortedTermIds(terms.size());
+    for (uint32_t i = 0; i < sortedTermIds.size(); i++)
+        sortedTermIds[i] = i;
+    sort(sortedTermIds.begin(), sortedTermIds.end(),
+         [&](uint32_t a, uint32_t b) { return *terms[a] < *terms[b]; });
+
+    vector<uint32_t> termRank(terms.size());
+    termPool.clear();
+    termOffsets.assign(1, 0);
+    for (uint32_t rank = 0; rank < sortedTermIds.size(); rank++)
+    {
+        if (termPool.size() + terms[sortedTermIds[rank]]->size() > MAX_INDEX_SIZE)
+        {
+            cerr << "Index too large for 32-bit ids" << endl;
+            clear();
+            return false;
+        }
+
+        termRank[sortedTermIds[rank]] = rank;
+        termPool += *terms[sortedTermIds[rank]];
+        termOffsets.push_back((uint32_t)termPool.size());
+    }
+
+    // Build postings grouped by term, each list sorted by document id
+    // (duplicated rows of the same path are merged here)
+    for (auto &termDoc : termDocs)
+        termDoc.first = termRank[termDoc.first];
+    sort(termDocs.begin(), termDocs.end());
+    termDocs.erase(unique(termDocs.begin(), termDocs.end()), termDocs.end());
+
+    postings.resize(termDocs.size());
+    postingOffsets.assign(terms.size() + 1, 0);
+    for (size_t i = 0; i < termDocs.size(); i++)
+    {
+        postings[i] = termDocs[i].second;
+        postingOffsets[termDocs[i].first + 1]++;
+    }
+    for (size_t i = 1; i < postingOffsets.size(); i++)
+        postingOffsets[i] += postingOffsets[i - 1];
+
+    pathPool.shrink_to_fit();
+    pathOffsets.shrink_to_fit();
+    termPool.shrink_to_fit();
+    termOffsets.shrink_to_fit();
+
+    return true;
+}
+
+/**
+ * @brief Finds documents containing all words
+ *
+ * @param words Lowercase search words
+ * @return Matching document ids, sorted
+ */
+vector<DocId> SearchIndex::search(const set<string> &words) const
+{
+    vector<pair<size_t, size_t>> ranges;
+    for (auto &word : words)
+    {
+        size_t termIndex;
+        if (!findTerm(word, termIndex))
+            return {};
+
+        ranges.push_back({postingOffsets[termIndex], postingOffsets[termIndex + 1]});
+    }
+
+    if (ranges.empty())
+        return {};
+
+    // Intersect starting from the shortest postings list
+    sort(ranges.begin(), ranges.end(), [](auto &a, auto &b)
+         { return (a.second - a.first) < (b.second - b.first); });
+
+    vector<DocId> results(postings.begin() + ranges[0].first,
+                          postings.begin() + ranges[0].second);
+    vector<DocId> intersection;
+    for (size_t i = 1; i < ranges.size() && !results.empty(); i++)
+    {
+        intersection.clear();
+        set_intersection(results.begin(), results.end(),
+                         postings.begin() + ranges[i].first,
+                         postings.begin() + ranges[i].second,
+                         back_inserter(intersection));
+        results.swap(intersection);
+    }
+
+    return results;
+}
+
+string_view SearchIndex::getPath(DocId docId) const
+{
+    return string_view(pathPool).substr(pathOffsets[docId],
+                                        pathOffsets[docId + 1] - pathOffsets[docId]);
+}
+
+size_t SearchIndex::getDocumentCount() const
+{
+    return pathOffsets.empty() ? 0 : pathOffsets.size() - 1;
+}
+
+size_t SearchIndex::getTermCount() const
+{
+    return termOffsets.empty() ? 0 : termOffsets.size() - 1;
+}
+
+/**
+ * @brief Prints resident bytes of each index component
+ *
+ * @param out Output stream
+ */
+void SearchIndex::printMemoryUsage(ostream &out) const
+{
+    size_t docTableBytes = pathPool.capacity() + pathOffsets.capacity() * sizeof(uint32_t);
+    size_t termDictionaryBytes = termPool.capacity() + termOffsets.capacity() * sizeof(uint32_t);
+    size_t postingsBytes = postingOffsets.capacity() * sizeof(uint32_t) +
+                           postings.capacity() * sizeof(DocId);
+
+    out << "Index: " << getDocumentCount() << " documents, " << getTermCount() << " terms" << endl;
+    out << "  Document table:  " << docTableBytes << " bytes" << endl;
+    out << "  Term dictionary: " << termDictionaryBytes << " bytes" << endl;
+    out << "  Postings:        " << postingsBytes << " bytes" << endl;
+    out << "  Total:           " << docTableBytes + termDictionaryBytes + postingsBytes << " bytes" << endl;
+}
+
+void SearchIndex::clear()
+{
+    pathPool.clear();
+    pathOffsets.clear();
+    termPool.clear();
+    termOffsets.clear();
+    postingOffsets.clear();
+    postings.clear();
+}
+
+bool SearchIndex::findTerm(string_view term, size_t &termIndex) const
+{
+    size_t low = 0;
+    size_t high = getTermCount();
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (getTerm(middle) < term)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if (low == getTermCount() || getTerm(low) != term)
+        return false;
+
+    termIndex = low;
+    return true;
+}
+
+string_view SearchIndex::getTerm(size_t termIndex) const
+{
+    return string_view(termPool).substr(termOffsets[termIndex],
+                                        termOffsets[termIndex + 1] - termOffsets[termIndex]);
+}
@@ -0,0 +1,58 @@
+/**
+ * @file SearchIndex.h
+ * @author Marc S. Ressl
+ * @brief In-memory search index
+ * @version 0.1
+ *
+ * @copyright Copyright (c) 2022-2024 Marc S. Ressl
+ */
+
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <cstdint>
+#include <ostream>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+typedef uint32_t DocId;
+
+/**
+ * @brief Read-only inverted index loaded from index.db.
+ *
+ * Paths and terms are interned in contiguous string pools and addressed
+ * by 32-bit ids, so there is no per-document or per-term heap string.
+ */
+class SearchIndex
+{
+public:
+    bool load(const std::string &databasePath);
+
+    std::vector<DocId> search(const std::set<std::string> &words) const;
+    std::string_view getPath(DocId docId) const;
+
+    size_t getDocumentCount() const;
+    size_t getTermCount() const;
+    void printMemoryUsage(std::ostream &out) const;
+
+private:
+    void clear();
+    bool findTerm(std::string_view term, size_t &termIndex) const;
+    std::string_view getTerm(size_t termIndex) const;
+
+    // Doc table: path of document i is pathPool[pathOffsets[i], pathOffsets[i + 1])
+    std::string pathPool;
+    std::vector<uint32_t> pathOffsets;
+
+    // Term dictionary, sorted: term i is termPool[termOffsets[i], termOffsets[i + 1])
+    std::string termPool;
+    std::vector<uint32_t> termOffsets;
+
+    // Postings: documents of term i are postings[postingOffsets[i], postingOffsets[i + 1])
+    std::vector<uint32_t> postingOffsets;
+    std::vector<DocId> postings;
+};
+
+#endif
@@ -7,7 +7,9 @@
  * @copyright Copyright (c) 2022-2024 Marc S. Ressl
  */
 
+#include <cctype>
 #include <iostream>
+#include <stdexcept>
 
 #include <microhttpd.h>
 
@@ -19,9 +21,54 @@ using namespace std;
 
 void printHelp()
 {
-    cout << "Usage: edahttpd -h WWW_PATH [-p PORT] " << endl;
+    cout << "Usage: edahttpd -h WWW_PATH [-p PORT] [OPTIONS]" << endl;
+    cout << "Options:" << endl;
+    cout << "  --max-connections N         Maximum concurrent connections" << endl;
+    cout << "  --max-connections-per-ip N  Maximum concurrent connections per IP" << endl;
+    cout << "  --timeout SECONDS           Idle (keep-alive) connection timeout" << endl;
+    cout << "  --threads N                 Thread pool size" << endl;
+    cout << "  --backlog N                 Listen backlog size" << endl;
+    cout << "  --reuse-port                Set SO_REUSEPORT, so several processes can share the port" << endl;
 };
 
+/**
+ * @brief Parses a non-negative integer option, if present
+ *
+ * @param parser The command line parser
+ * @param name The option name
+ * @param value Set to the parsed value when the option is present
+ * @return true Option absent or valid
+ * @return false Option value is not a non-negative integer
+ */
+bool parseUnsignedOption(CommandLineParser &parser, const string &name, unsigned int &value)
+{
+    if (!parser.hasOption(name))
+        return true;
+
+    string text = parser.getOption(name);
+    try
+    {
+        // stoi would accept leading whitespace and signs
+        if (text.empty() || !isdigit((unsigned char)text[0]))
+            throw invalid_argument(text);
+
+        size_t parsedLength;
+        int parsed = stoi(text, &parsedLength);
+        if (parsedLength != text.size())
+            throw invalid_argument(text);
+
+        value = parsed;
+    }
+    catch (const logic_error &) // invalid_argument or out_of_range
+    {
+        cout << "error: invalid value for " << name << ": \"" << text << "\"." << endl;
+
+        return false;
+    }
+
+    return true;
+}
+
 int main(int argc, const char *argv[])
 {
     CommandLineParser parser(argc, argv);
@@ -29,6 +76,7 @@ int main(int argc, const char *argv[])
     // Configuration
     int port = 8000;
     string wwwPath;
+    HttpServerOptions serverOptions;
 
     // Parse command line
     if (!parser.hasOption("-h"))
@@ -42,14 +90,37 @@ int main(int argc, const char *argv[])
    
     wwwPath = parser.getOption("-h");
 
-    if (parser.hasOption("-p"))
-        port = stoi(parser.getOption("-p"));
+    unsigned int portValue = port;
+    if (!parseUnsignedOption(parser, "-p", portValue) ||
+        !parseUnsignedOption(parser, "--max-connections", serverOptions.connectionLimit) ||
+        !parseUnsignedOption(parser, "--max-connections-per-ip", serverOptions.perIpConnectionLimit) ||
+        !parseUnsignedOption(parser, "--timeout", serverOptions.connectionTimeout) ||
+        !parseUnsignedOption(parser, "--threads", serverOptions.threadPoolSize) ||
+        !parseUnsignedOption(parser, "--backlog", serverOptions.listenBacklog))
+    {
+        printHelp();
+
+        return 1;
+    }
 
-    // Start server
-    HttpServer server(port);
+    // Port 0 would make libmicrohttpd bind a random port
+    if (portValue == 0 || portValue > 65535)
+    {
+        cout << "error: invalid port: " << portValue << "." << endl;
 
+        printHelp();
+
+        return 1;
+    }
+    port = portValue;
+
+    serverOptions.reusePort = parser.hasOption("--reuse-port");
+
+    // Load the index before accepting connections
     HttpRequestHandler edaOogleHttpRequestHandler(wwwPath);
-    server.setHttpRequestHandler(&edaOogleHttpRequestHandler);
+
+    // Start server
+    HttpServer server(port, &edaOogleHttpRequestHandler, serverOptions);
 
     if (server.isRunning())
     {
@@ -61,4 +132,10 @@ int main(int argc, const char *argv[])
 
         cout << "Stopping server..." << endl;
     }
+    else
+    {
+        cout << "error: could not start server on port " << port << "." << endl;
+
+        return 1;
+    }
 }
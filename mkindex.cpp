@@ -9,6 +9,9 @@
 #define SQLITE_ENABLE_FTS5  // Must be defined before including sqlite3.h
 #include <iostream>
 #include <set>
+#include <unordered_set>
+#include <vector>
+#include <string_view>
 #include <string>
 #include <sstream>
 #include <fstream>
@@ -16,8 +19,8 @@
 #include <sqlite3.h>
 #include <cctype>
 #include <algorithm>
-#include <regex>
 #include "CommandLineParser.h"
+#include "HtmlText.h"
 
 using namespace std;
 
@@ -32,20 +35,106 @@ static int onDatabaseEntry(void* userdata, int argc, char** argv, char** azColNa
 
 // Extract clean text from HTML content
 string extractCleanText(const string& content) {
-    // Remove HTML tags, comments, and scripts
-    string clean = regex_replace(content, regex("<!--.*?-->|<script.*?</script>|</?[^>]+>", regex::icase), "");
+    // Remove HTML comments, scripts, styles and tags
+    string text = normalizeSpaces(removeMarkup(content));
 
-    // Convert to lowercase
-    transform(clean.begin(), clean.end(), clean.begin(), ::tolower);
+    // Normalize each word as the search side does (see normalizeWord)
+    string clean;
+    clean.reserve(text.size());
+    string normalized;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t wordEnd = min(text.find(' ', pos), text.size());
+        normalizeWord(string_view(text).substr(pos, wordEnd - pos), normalized);
+        if (!normalized.empty()) {
+            if (!clean.empty()) clean += ' ';
+            clean += normalized;
+        }
+        pos = wordEnd + 1;
+    }
 
-    // Remove punctuation and normalize spaces
-    clean = regex_replace(clean, regex("[^a-z\\s]+"), "");
-    clean = regex_replace(clean, regex("\\s+"), " ");
+    return clean;
+}
 
-    // Trim leading/trailing spaces
-    clean = regex_replace(clean, regex("^\\s+|\\s+$"), "");
+// Extract display text from HTML content for result snippets.
+// Same markup stripping as extractCleanText, but keeps case and punctuation.
+string extractDisplayText(const string& content) {
+    return normalizeSpaces(removeMarkup(content));
+}
 
-    return clean;
+// Snippet windows: short runs of display text around the first occurrence
+// of each term. Capped per document, so storage and lookup stay bounded.
+const size_t SNIPPET_WORDS = 24;
+const size_t SNIPPET_CONTEXT_WORDS = SNIPPET_WORDS / 4;
+const size_t MAX_SNIPPET_WINDOWS = 256;
+
+// Builds the snippet windows of a document and maps each normalized term
+// to the window holding its first occurrence
+void buildSnippets(const string& displayText, vector<string>& windows, vector<pair<string, int>>& termWindows) {
+    windows.clear();
+    termWindows.clear();
+
+    vector<string_view> words;
+    size_t pos = 0;
+    while (pos < displayText.size()) {
+        size_t wordEnd = min(displayText.find(' ', pos), displayText.size());
+        words.push_back(string_view(displayText).substr(pos, wordEnd - pos));
+        pos = wordEnd + 1;
+    }
+
+    unordered_set<string> seenTerms;
+    string normalized;
+    size_t windowEnd = 0;
+    for (size_t i = 0; i < words.size(); i++) {
+        normalizeWord(words[i], normalized);
+        if (normalized.size() < MIN_WORD_LENGTH || seenTerms.count(normalized)) continue;
+
+        // Start a new window unless the word is inside the last one
+        if (windows.empty() || i >= windowEnd) {
+            if (windows.size() == MAX_SNIPPET_WINDOWS) break;
+
+            size_t start = max(i > SNIPPET_CONTEXT_WORDS ? i - SNIPPET_CONTEXT_WORDS : 0, windowEnd);
+            windowEnd = min(start + SNIPPET_WORDS, words.size());
+
+            string window = start > 0 ? "..." : "";
+            for (size_t j = start; j < windowEnd; j++) {
+                if (!window.empty()) window += ' ';
+                window += words[j];
+            }
+            if (windowEnd < words.size()) window += " ...";
+            windows.push_back(window);
+        }
+
+        seenTerms.insert(normalized);
+        termWindows.push_back({normalized, (int)windows.size() - 1});
+    }
+}
+
+// Inserts the snippet windows and term map of one document
+bool insertSnippets(sqlite3* db, sqlite3_stmt* insertSnippetDoc, sqlite3_stmt* insertWindow, sqlite3_stmt* insertTerm,
+                    const string& path, const vector<string>& windows, const vector<pair<string, int>>& termWindows) {
+    bool ok = sqlite3_bind_text(insertSnippetDoc, 1, path.c_str(), -1, SQLITE_STATIC) == SQLITE_OK &&
+              sqlite3_step(insertSnippetDoc) == SQLITE_DONE;
+    sqlite3_reset(insertSnippetDoc);
+    sqlite3_int64 docId = sqlite3_last_insert_rowid(db);
+
+    for (size_t i = 0; ok && i < windows.size(); i++) {
+        ok = sqlite3_bind_int64(insertWindow, 1, docId) == SQLITE_OK &&
+             sqlite3_bind_int(insertWindow, 2, (int)i) == SQLITE_OK &&
+             sqlite3_bind_text(insertWindow, 3, windows[i].c_str(), -1, SQLITE_STATIC) == SQLITE_OK &&
+             sqlite3_step(insertWindow) == SQLITE_DONE;
+        sqlite3_reset(insertWindow);
+    }
+
+    for (size_t i = 0; ok && i < termWindows.size(); i++) {
+        ok = sqlite3_bind_int64(insertTerm, 1, docId) == SQLITE_OK &&
+             sqlite3_bind_text(insertTerm, 2, termWindows[i].first.c_str(), -1, SQLITE_STATIC) == SQLITE_OK &&
+             sqlite3_bind_int(insertTerm, 3, termWindows[i].second) == SQLITE_OK &&
+             sqlite3_step(insertTerm) == SQLITE_DONE;
+        sqlite3_reset(insertTerm);
+    }
+
+    return ok;
 }
 
 int main(int argc, const char* argv[]) {
@@ -84,6 +173,34 @@ int main(int argc, const char* argv[]) {
     }
     cout << "FTS5 table created successfully" << endl;
 
+    // Step 3.1: Clear documents from a previous run, so they are not indexed twice
+    if (sqlite3_exec(db, "DELETE FROM search_index;", nullptr, 0, &errMsg) != SQLITE_OK) {
+        cout << "Error: failed to clear FTS5 table: " << errMsg << endl;
+        sqlite3_free(errMsg);
+        sqlite3_close(db);
+        return 1;
+    }
+
+    // Step 3.2: Create snippet tables (rebuilt on every run)
+    cout << "Creating snippet tables..." << endl;
+    if (sqlite3_exec(db,
+                     "DROP TABLE IF EXISTS forward_index;"
+                     "DROP TABLE IF EXISTS snippet_terms;"
+                     "DROP TABLE IF EXISTS snippet_windows;"
+                     "DROP TABLE IF EXISTS snippet_docs;"
+                     "CREATE TABLE snippet_docs (doc_id INTEGER PRIMARY KEY, path TEXT UNIQUE);"
+                     "CREATE TABLE snippet_windows (doc_id INTEGER, window INTEGER, text TEXT,"
+                     " PRIMARY KEY (doc_id, window)) WITHOUT ROWID;"
+                     "CREATE TABLE snippet_terms (doc_id INTEGER, term TEXT, window INTEGER,"
+                     " PRIMARY KEY (doc_id, term)) WITHOUT ROWID;",
+                     nullptr, 0, &errMsg) != SQLITE_OK) {
+        cout << "Error: failed to create snippet tables: " << errMsg << endl;
+        sqlite3_free(errMsg);
+        sqlite3_close(db);
+        return 1;
+    }
+    cout << "Snippet tables created successfully" << endl;
+
     // Step 4: Process HTML files
     cout << "Processing HTML files..." << endl;
     string wikiPath = (filesystem::path(wwwPath) / "wiki").string();
@@ -101,6 +218,22 @@ int main(int argc, const char* argv[]) {
         sqlite3_close(db);
         return 1;
     }
+    sqlite3_stmt* insertSnippetDoc = nullptr;
+    sqlite3_stmt* insertWindow = nullptr;
+    sqlite3_stmt* insertTerm = nullptr;
+    if (sqlite3_prepare_v2(db, "INSERT INTO snippet_docs (path) VALUES (?);", -1, &insertSnippetDoc, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, "INSERT INTO snippet_windows (doc_id, window, text) VALUES (?, ?, ?);", -1, &insertWindow, nullptr) != SQLITE_OK ||
+        sqlite3_prepare_v2(db, "INSERT INTO snippet_terms (doc_id, term, window) VALUES (?, ?, ?);", -1, &insertTerm, nullptr) != SQLITE_OK) {
+        cout << "Error: failed to prepare statement: " << sqlite3_errmsg(db) << endl;
+        sqlite3_finalize(insertDoc);
+        sqlite3_finalize(insertSnippetDoc);
+        sqlite3_finalize(insertWindow);
+        sqlite3_finalize(insertTerm);
+        sqlite3_close(db);
+        return 1;
+    }
+    vector<string> snippetWindows;
+    vector<pair<string, int>> snippetTermWindows;
 
     for (const auto& entry : filesystem::recursive_directory_iterator(wikiPath)) {
         if (entry.path().extension() != ".html") continue;
@@ -120,6 +253,7 @@ int main(int argc, const char* argv[]) {
             cout << "Warning: no valid text in: " << entry.path().string() << endl;
             continue;
         }
+        buildSnippets(extractDisplayText(content), snippetWindows, snippetTermWindows);
 
         if (sqlite3_exec(db, "BEGIN;", nullptr, 0, &errMsg) != SQLITE_OK) {
             cout << "Error: failed to begin transaction: " << errMsg << endl;
@@ -138,6 +272,12 @@ int main(int argc, const char* argv[]) {
         }
         sqlite3_reset(insertDoc);
 
+        if (!insertSnippets(db, insertSnippetDoc, insertWindow, insertTerm, relPath, snippetWindows, snippetTermWindows)) {
+            cout << "Error: failed to insert snippets: " << sqlite3_errmsg(db) << endl;
+            sqlite3_exec(db, "ROLLBACK;", nullptr, 0, nullptr);
+            continue;
+        }
+
         if (sqlite3_exec(db, "COMMIT;", nullptr, 0, &errMsg) != SQLITE_OK) {
             cout << "Error: failed to commit transaction: " << errMsg << endl;
             sqlite3_free(errMsg);
@@ -149,6 +289,9 @@ int main(int argc, const char* argv[]) {
     // Step 6: Finalize and close database
     cout << "Finalizing statements..." << endl;
     sqlite3_finalize(insertDoc);
+    sqlite3_finalize(insertSnippetDoc);
+    sqlite3_finalize(insertWindow);
+    sqlite3_finalize(insertTerm);
 
     cout << "Closing database..." << endl;
     if (sqlite3_close(db) != SQLITE_OK) {